@@ -4,6 +4,12 @@
 /// @brief type for element index in list
 typedef int list_el_id_t;
 
+/// @brief user element formatter, writes element to str (no more than str_size chars, no '\0' needed),
+///        returns length of full output like snprintf, output is truncated if it is not less than str_size
+typedef size_t (*list_elem_formatter_t)(const void * elem, size_t elem_size, char * str, size_t str_size);
+
+struct list_snapshot;
+
 /// @brief type for list
 typedef struct
 {
@@ -17,8 +23,30 @@ typedef struct
     list_el_id_t capacity;
     list_el_id_t size;
     list_el_id_t free;
+
+    list_elem_formatter_t formatter;
+
+    struct list_snapshot * snapshots;
 } list_t;
 
+/// @brief read-only view of the list, shares storage with the live list;
+///        before writer changes a segment of data, next or prev, the segment is saved to alive snapshots
+typedef struct list_snapshot
+{
+    list_t * list;                          ///< live list, NULL when snapshot is detached from it
+    struct list_snapshot * next_snapshot;
+
+    size_t elem_size;
+    list_el_id_t capacity;
+    list_el_id_t size;
+    list_el_id_t free;
+
+    list_el_id_t seg_count;
+    void         ** data_segs;              ///< saved segments, NULL while segment is shared with the list
+    list_el_id_t ** next_segs;
+    list_el_id_t ** prev_segs;
+} list_snapshot_t;
+
 /// @brief type for status of list in some situations
 typedef enum
 {
@@ -35,9 +63,61 @@ typedef enum
     LIST_SIZE_OUT_ERROR,
     LIST_CAPACITY_OUT_ERROR,
     LIST_NO_ELEM_SIZE_ERROR,
-    LIST_OVERFLOW
+    LIST_OVERFLOW,
+    LIST_CYCLE_ERROR,
+    LIST_SIZE_MISMATCH_ERROR,
+    LIST_FREE_CHAIN_ERROR,
+    LIST_FREE_LEAK_ERROR,
+    LIST_PRINT_ALLOC_ERROR,
+    LIST_PRINT_BUF_OVERFLOW,
+    LIST_PRINT_WRITE_ERROR,
+    LIST_SNAPSHOT_ALLOC_ERROR,
+    LIST_BATCH_ALLOC_ERROR,
+    LIST_BATCH_OP_ERROR
 } list_status_t;
 
+/// @brief type of operation in list batch
+typedef enum
+{
+    LIST_OP_INSERT_AFTER,
+    LIST_OP_INSERT_BEFORE,
+    LIST_OP_REMOVE
+} list_op_type_t;
+
+/// @brief one recorded operation of list batch
+typedef struct
+{
+    list_op_type_t type;
+    list_el_id_t index;
+    list_el_id_t val_index;         ///< number of insert in batch vals, -1 for remove
+} list_op_t;
+
+/// @brief batch of list operations, they are applied all together or not applied at all
+typedef struct
+{
+    list_t * list;
+
+    list_op_t * ops;
+    void * vals;                    ///< copies of inserted values, one slot for each insert
+
+    list_el_id_t ops_count;
+    list_el_id_t ops_capacity;
+    list_el_id_t insert_count;
+    list_el_id_t vals_capacity;
+
+    list_el_id_t failed_op;         ///< number of op which failed in last commit, -1 if none
+} list_batch_t;
+
+/// @brief detailed result of full list verification
+typedef struct
+{
+    list_status_t status;
+
+    list_el_id_t bad_index;     ///< first index where error was found, -1 if not bound to element
+    list_el_id_t used_count;    ///< number of elements walked in main list
+    list_el_id_t free_count;    ///< number of elements walked in free chain
+} list_verify_report_t;
+
 /// @brief constructs list
 list_status_t listCtor(list_t * list, size_t elem_size, list_el_id_t capacity);
 
@@ -47,7 +127,18 @@ list_status_t listDtor(list_t * list);
 /// @brief prints list data to stdout
 list_status_t listPrint(list_t * list);
 
-/// @brief get element data pointer by its index
+/// @brief prints list data to out_file, output is written in large chunks
+list_status_t listPrintToFile(list_t * list, FILE * out_file);
+
+/// @brief prints list data to buf (no more than buf_size chars, '\0' is not written), writes printed length to written
+list_status_t listPrintToBuf(list_t * list, char * buf, size_t buf_size, size_t * written);
+
+/// @brief sets formatter for elements in prints and dumps, NULL means hex bytes
+list_status_t listSetElemFormatter(list_t * list, list_elem_formatter_t formatter);
+
+/// @brief get element data pointer by its index;
+///        if snapshots are alive, element data segment is saved to them first (NULL if saving failed),
+///        so writes through pointer are not seen in snapshots
 void * listGetElem(list_t * list, list_el_id_t index);
 
 /*--------------------INDEXES--------------------*/
@@ -86,6 +177,10 @@ list_status_t listRemoveLast (list_t * list);
 /// @brief checks list for some errors
 list_status_t listVerify(list_t * list);
 
+/// @brief checks list, main list and free chain, writes detailed report (report may be NULL);
+///        runs in one thread, O(capacity)
+list_status_t listVerifyFull(list_t * list, list_verify_report_t * report);
+
 /// @brief makes dot file for dump
 list_status_t listMakeDot(list_t * list, FILE * dot_file);
 
@@ -95,7 +190,60 @@ list_status_t listDumpGraph(list_t * list);
 /// @brief makes dump to log file
 list_status_t listDump(list_t * list);
 
+/// @brief reserves place for capacity elements, so inserts do not reallocate
+list_status_t listReserve(list_t * list, list_el_id_t capacity);
+
+/*---------------------BATCH---------------------*/
+/// @brief constructs empty batch of operations on list
+list_status_t listBatchCtor(list_batch_t * batch, list_t * list);
+
+/// @brief destructs batch, recorded operations are dropped
+list_status_t listBatchDtor(list_batch_t * batch);
+
+/// @brief drops recorded operations
+list_status_t listBatchClear(list_batch_t * batch);
+
+/// @brief records insert after element with index, val is copied
+list_status_t listBatchInsertAfter(list_batch_t * batch, list_el_id_t index, const void * val);
+
+/// @brief records insert before element with index, val is copied
+list_status_t listBatchInsertBefore(list_batch_t * batch, list_el_id_t index, const void * val);
+
+/// @brief records removing element with index
+list_status_t listBatchRemove(list_batch_t * batch, list_el_id_t index);
+
+/// @brief applies recorded operations in order and verifies list once,
+///        on error links, data, size, free and capacity are restored and batch keeps its operations
+list_status_t listBatchCommit(list_batch_t * batch);
+/*-----------------------------------------------*/
+
+/*-------------------SNAPSHOTS-------------------*/
+/// @brief makes snapshot of the list, it stays consistent while list is changed;
+///        snapshots are not synchronized, it must be serialized with list writes (it adds to list->snapshots)
+list_status_t listSnapshot(list_t * list, list_snapshot_t ** snapshot);
+
+/// @brief releases snapshot;
+///        it must be serialized with list writes, they walk list->snapshots which it unlinks from
+list_status_t listSnapshotRelease(list_snapshot_t * snapshot);
+
+/// @brief returns next index in snapshot, listSnapshotNext(snapshot, 0) is head;
+///        shared segments are read through snapshot->list->next, so it must not run concurrently with list writes
+list_el_id_t listSnapshotNext(const list_snapshot_t * snapshot, list_el_id_t index);
+
+/// @brief returns prev index in snapshot, listSnapshotPrev(snapshot, 0) is tail;
+///        shared segments are read through snapshot->list->prev, so it must not run concurrently with list writes
+list_el_id_t listSnapshotPrev(const list_snapshot_t * snapshot, list_el_id_t index);
+
+/// @brief copies element data in snapshot by its index to dst (elem_size bytes), it is the main way to read data
+list_status_t listSnapshotCopyElem(const list_snapshot_t * snapshot, list_el_id_t index, void * dst);
+
+/// @brief get element data pointer in snapshot by its index;
+///        pointer may point to live list data, so it is valid only until the next write to the list
+const void * listSnapshotGetElem(const list_snapshot_t * snapshot, list_el_id_t index);
+/*-----------------------------------------------*/
+
 const size_t CAP_MULTIPLIER = 2;
 const size_t MIN_CAPACITY = 4;
+const list_el_id_t SNAPSHOT_SEG_LEN = 1024;
 
 #endif
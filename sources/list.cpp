@@ -10,11 +10,72 @@ const size_t MAX_FILE_NAME = 256;
 const int  IMG_WIDTH_IN_PERCENTS = 95;
 const int IMG_HEIGTH_IN_PERCENTS = 40;
 
-/// @brief prints one element of the list to stdout
-static list_status_t printOneElem(list_t * list, list_el_id_t index);
+const size_t OUT_CHUNK_SIZE   = 1 << 16;
+const size_t OUT_ELEM_RESERVE = 256;
+const size_t OUT_INT_MAX_LEN  = 24;
 
-/// @brief writes element as a string to str
-static list_status_t elemToStr(list_t * list, list_el_id_t index, char * str);
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+/// @brief buffered output to file (flushed by chunks) or to caller buffer
+typedef struct
+{
+    char * buf;
+    size_t buf_size;
+    size_t pos;
+
+    FILE * file;
+    bool overflow;              ///< nothing is written after it is set
+    list_status_t error;        ///< reason of the first fail
+} out_buf_t;
+
+/// @brief makes output buffer which is flushed to file
+static list_status_t outCtorFile(out_buf_t * out, FILE * file);
+
+/// @brief makes output buffer over caller memory
+static list_status_t outCtorBuf(out_buf_t * out, char * buf, size_t buf_size);
+
+/// @brief flushes output buffer, frees its memory if it was allocated, returns first error of output
+static list_status_t outDtor(out_buf_t * out);
+
+/// @brief stops output, remembers error if it is the first one
+static void outFail(out_buf_t * out, list_status_t error);
+
+/// @brief writes buffered data to file
+static void outFlush(out_buf_t * out);
+
+/// @brief makes at least len chars available in buffer, returns false if it is not possible
+static bool outReserve(out_buf_t * out, size_t len);
+
+/// @brief writes len chars of str
+static void outWrite(out_buf_t * out, const char * str, size_t len);
+
+/// @brief writes null-terminated str
+static void outStr(out_buf_t * out, const char * str);
+
+/// @brief writes val in decimal
+static void outInt(out_buf_t * out, long long val);
+
+/// @brief writes element with list formatter or as hex bytes, formatter output is escaped for dot record label if dot_escape
+static void outElem(out_buf_t * out, list_t * list, list_el_id_t index, bool dot_escape);
+
+/// @brief writes element with list formatter, output which does not fit in chunk goes through temporary buffer
+static void outFormatted(out_buf_t * out, list_t * list, const void * elem, bool dot_escape);
+
+/// @brief writes len chars of str, escaping chars which are special in dot record labels
+static void outDotEscaped(out_buf_t * out, const char * str, size_t len);
+
+/// @brief checks if char is special in dot record labels
+static bool isDotSpecial(char c);
+
+/// @brief checks if str has chars which are special in dot record labels
+static bool hasDotSpecial(const char * str, size_t len);
+
+/// @brief prints list data to output buffer
+static list_status_t printList(list_t * list, out_buf_t * out);
+
+/// @brief writes dot arrows for chain of links starting from start
+static void dotLinkChain(out_buf_t * dot, list_t * list, list_el_id_t * links, list_el_id_t start,
+                         bool through_zero, const char * color_str);
 
 /// @brief updates list.free, reallocates memory if needed
 static list_status_t updateFree(list_t * list);
@@ -22,6 +83,81 @@ static list_status_t updateFree(list_t * list);
 /// @brief reallocates list, new capacity = capacity * CAP_MULTIPLIER
 static list_status_t listRealloc(list_t * list);
 
+/// @brief reallocates list to new_capacity, new elements are added to free chain
+static list_status_t listReallocTo(list_t * list, list_el_id_t new_capacity);
+
+/// @brief entry of batch undo log, old value of one link
+typedef struct
+{
+    list_el_id_t * link;
+    list_el_id_t old_val;
+} undo_entry_t;
+
+/// @brief batch undo log, old values of changed links and of overwritten element data
+typedef struct
+{
+    undo_entry_t * links;
+    size_t links_count;
+
+    char * data;                    ///< old data of elements, one slot for each insert
+    list_el_id_t * data_index;
+    size_t data_count;
+} undo_log_t;
+
+/// @brief number of links written by one batch operation
+const list_el_id_t BATCH_LINKS_PER_OP = 4;
+
+/// @brief makes undo log for ops_count operations with insert_count inserts
+static list_status_t undoLogCtor(undo_log_t * undo, list_el_id_t ops_count, list_el_id_t insert_count, size_t elem_size);
+
+/// @brief frees undo log memory
+static void undoLogDtor(undo_log_t * undo);
+
+/// @brief applies one batch operation, writes old values of changed links and data to undo log
+static list_status_t batchApplyOp(list_t * list, const list_op_t * op, const void * val, undo_log_t * undo);
+
+/// @brief sets link to new_val, saving old value to undo log
+static void batchSetLink(list_el_id_t * link, list_el_id_t new_val, undo_log_t * undo);
+
+/// @brief writes val to element data, saving old data to undo log
+static void batchSetData(list_t * list, list_el_id_t index, const void * val, undo_log_t * undo);
+
+/// @brief restores links and data from undo log and list header
+static void batchRollback(list_t * list, undo_log_t * undo,
+                          list_el_id_t old_size, list_el_id_t old_free, list_el_id_t old_capacity);
+
+/// @brief records operation to batch
+static list_status_t batchAddOp(list_batch_t * batch, list_op_type_t type, list_el_id_t index, const void * val);
+
+/// @brief flags of list arrays for snapshot segment saving
+enum snap_arrays
+{
+    SNAP_NEXT = 1 << 0,
+    SNAP_PREV = 1 << 1,
+    SNAP_DATA = 1 << 2
+};
+
+/// @brief saves segments with index of arrays from arrays flags to alive snapshots, must be called before write
+static list_status_t snapshotsSave(list_t * list, list_el_id_t index, unsigned arrays);
+
+/// @brief saves one segment of arrays to snapshot if it is not saved yet
+static list_status_t snapshotSaveSeg(list_snapshot_t * snapshot, list_el_id_t seg, unsigned arrays);
+
+/// @brief saves all shared segments to snapshot and detaches it from the list
+static list_status_t snapshotDetach(list_snapshot_t * snapshot);
+
+/// @brief checks list header fields
+static list_status_t verifyHeader(list_t * list);
+
+/// @brief walks main list from 0 with bounded number of steps, checks prev/next symmetry
+static list_status_t verifyMainList(list_t * list, list_verify_report_t * report);
+
+/// @brief walks free chain with bounded number of steps, checks that it has only free elements
+static list_status_t verifyFreeChain(list_t * list, list_verify_report_t * report);
+
+/// @brief returns first slot which is neither in main list nor in free chain, -1 if not found
+static list_el_id_t findLostSlot(list_t * list);
+
 list_status_t listCtor(list_t * list, size_t elem_size, list_el_id_t capacity)
 {
     assert(list);
@@ -29,6 +165,8 @@ list_status_t listCtor(list_t * list, size_t elem_size, list_el_id_t capacity)
     list->capacity = capacity;
     list->size = 0;
     list->elem_size = elem_size;
+    list->formatter = NULL;
+    list->snapshots = NULL;
     list->data = calloc(capacity, elem_size);
 
     list->next = (list_el_id_t *)calloc(capacity + 1, sizeof(list_el_id_t));
@@ -59,6 +197,13 @@ list_status_t listDtor(list_t * list)
     if (list->data == NULL || list->prev == NULL || list->next == NULL)
         return LIST_DTOR_FREE_NULL;
 
+    // alive snapshots keep their own copies and stay valid until they are released
+    while (list->snapshots != NULL){
+        list_status_t status = snapshotDetach(list->snapshots);
+        if (status != LIST_SUCCESS)
+            return status;
+    }
+
     free(list->data);
     list->data = NULL;
 
@@ -100,6 +245,15 @@ list_status_t listInsertAfter(list_t * list, list_el_id_t index, void * val)
 
     list_el_id_t next_index = list->next[index];
     list_el_id_t  new_index = list->free;
+
+    list_status_t save_status = snapshotsSave(list, index, SNAP_NEXT);
+    if (save_status == LIST_SUCCESS)
+        save_status = snapshotsSave(list, new_index, SNAP_NEXT | SNAP_PREV | SNAP_DATA);
+    if (save_status == LIST_SUCCESS)
+        save_status = snapshotsSave(list, next_index, SNAP_PREV);
+    if (save_status != LIST_SUCCESS)
+        return save_status;
+
     updateFree(list);
 
     list->next[index] = new_index;
@@ -108,11 +262,11 @@ list_status_t listInsertAfter(list_t * list, list_el_id_t index, void * val)
     list->next[new_index] = next_index;
     list->prev[next_index] = new_index;
 
+    list->size++;
+
     void * new_elem_val = listGetElem(list, new_index);
     memcpy(new_elem_val, val, list->elem_size);
 
-    list->size++;
-
     logPrint(LOG_DEBUG_PLUS, "exiting listInsertAfter\n");
     return LIST_SUCCESS;
 }
@@ -131,6 +285,15 @@ list_status_t listInsertBefore(list_t * list, list_el_id_t index, void * val)
 
     list_el_id_t prev_index = list->prev[index];
     list_el_id_t  new_index = list->free;
+
+    list_status_t save_status = snapshotsSave(list, index, SNAP_PREV);
+    if (save_status == LIST_SUCCESS)
+        save_status = snapshotsSave(list, new_index, SNAP_NEXT | SNAP_PREV | SNAP_DATA);
+    if (save_status == LIST_SUCCESS)
+        save_status = snapshotsSave(list, prev_index, SNAP_NEXT);
+    if (save_status != LIST_SUCCESS)
+        return save_status;
+
     updateFree(list);
 
     list->prev[index] = new_index;
@@ -139,11 +302,11 @@ list_status_t listInsertBefore(list_t * list, list_el_id_t index, void * val)
     list->prev[new_index] = prev_index;
     list->next[prev_index] = new_index;
 
+    list->size++;
+
     void * new_elem_val = listGetElem(list, new_index);
     memcpy(new_elem_val, val, list->elem_size);
 
-    list->size++;
-
     logPrint(LOG_DEBUG_PLUS, "exiting listInsertBefore\n");
     return LIST_SUCCESS;
 }
@@ -173,6 +336,14 @@ list_status_t listRemove(list_t * list, list_el_id_t index)
     list_el_id_t prev_index = list->prev[index];
     list_el_id_t next_index = list->next[index];
 
+    list_status_t save_status = snapshotsSave(list, prev_index, SNAP_NEXT);
+    if (save_status == LIST_SUCCESS)
+        save_status = snapshotsSave(list, next_index, SNAP_PREV);
+    if (save_status == LIST_SUCCESS)
+        save_status = snapshotsSave(list, index, SNAP_NEXT | SNAP_PREV);
+    if (save_status != LIST_SUCCESS)
+        return save_status;
+
     list->next[prev_index] = next_index;
     list->prev[next_index] = prev_index;
 
@@ -214,21 +385,46 @@ static list_status_t updateFree(list_t * list)
 static list_status_t listRealloc(list_t * list)
 {
     assert(list);
+    list_el_id_t new_capacity = (list->capacity > 0) ? list->capacity * CAP_MULTIPLIER : MIN_CAPACITY;
+    return listReallocTo(list, new_capacity);
+}
+
+list_status_t listReserve(list_t * list, list_el_id_t capacity)
+{
+    assert(list);
+    if (capacity <= list->capacity)
+        return LIST_SUCCESS;
+
+    return listReallocTo(list, capacity);
+}
+
+static list_status_t listReallocTo(list_t * list, list_el_id_t new_capacity)
+{
+    assert(list);
+    assert(new_capacity > list->capacity);
     assert(listVerify(list) == LIST_SUCCESS);
     logPrint(LOG_DEBUG_PLUS, "started reallocating...\n");
-    list_el_id_t new_capacity = (list->capacity > 0) ? list->capacity * CAP_MULTIPLIER : MIN_CAPACITY;
-    list->data = realloc(list->data, new_capacity * list->elem_size);
-    list->next = (list_el_id_t *)realloc(list->next, (new_capacity + 1) * sizeof(list_el_id_t));
-    list->prev = (list_el_id_t *)realloc(list->prev, (new_capacity + 1) * sizeof(list_el_id_t));
+    void * new_data = realloc(list->data, (size_t)new_capacity * list->elem_size);
+    if (new_data == NULL)
+        return LIST_REALLOC_ERROR;
+    list->data = new_data;
 
-    if (list->data == NULL || list->next == NULL || list->prev == NULL)
+    list_el_id_t * new_next = (list_el_id_t *)realloc(list->next, (size_t)(new_capacity + 1) * sizeof(list_el_id_t));
+    if (new_next == NULL)
         return LIST_REALLOC_ERROR;
+    list->next = new_next;
+
+    list_el_id_t * new_prev = (list_el_id_t *)realloc(list->prev, (size_t)(new_capacity + 1) * sizeof(list_el_id_t));
+    if (new_prev == NULL)
+        return LIST_REALLOC_ERROR;
+    list->prev = new_prev;
 
     for (list_el_id_t index = list->capacity + 1; index < new_capacity; index++){
         list->next[index] = index + 1;
         list->prev[index] = -1;
     }
-    list->next[new_capacity] = 0;
+    // new elements are put before old free chain
+    list->next[new_capacity] = list->free;
     list->prev[new_capacity] = -1;
     list->free = list->capacity + 1;
     list->capacity = new_capacity;
@@ -239,50 +435,532 @@ static list_status_t listRealloc(list_t * list)
 list_status_t listPrint(list_t * list)
 {
     assert(list);
+    return listPrintToFile(list, stdout);
+}
+
+list_status_t listPrintToFile(list_t * list, FILE * out_file)
+{
+    assert(list);
+    assert(out_file);
+    out_buf_t out = {};
+    list_status_t status = outCtorFile(&out, out_file);
+    if (status != LIST_SUCCESS)
+        return status;
+
+    status = printList(list, &out);
+    list_status_t flush_status = outDtor(&out);
+    return (status != LIST_SUCCESS) ? status : flush_status;
+}
+
+list_status_t listPrintToBuf(list_t * list, char * buf, size_t buf_size, size_t * written)
+{
+    assert(list);
+    assert(buf);
+    out_buf_t out = {};
+    outCtorBuf(&out, buf, buf_size);
+
+    list_status_t status = printList(list, &out);
+    if (written != NULL)
+        *written = out.pos;
+
+    outDtor(&out);
+    return status;
+}
+
+list_status_t listSetElemFormatter(list_t * list, list_elem_formatter_t formatter)
+{
+    assert(list);
+    list->formatter = formatter;
+    return LIST_SUCCESS;
+}
+
+static list_status_t printList(list_t * list, out_buf_t * out)
+{
+    assert(list);
+    assert(out);
     assert(listVerify(list) == LIST_SUCCESS);
-    printf("\nstarted printing list\n");
+    outStr(out, "\nstarted printing list\n");
 
     list_el_id_t index = list->next[0];
-    while (index != 0){
-        printf("elem #%d: ", index);
-        printOneElem(list, index);
-        putchar('\n');
+    while (index != 0 && !out->overflow){
+        outStr(out, "elem #");
+        outInt(out, index);
+        outStr(out, ": ");
+        outElem(out, list, index, false);
+        outWrite(out, "\n", 1);
         index = list->next[index];
     }
-    printf("ended printing list\n");
+    outStr(out, "ended printing list\n");
+    return out->error;
+}
+
+static list_status_t outCtorFile(out_buf_t * out, FILE * file)
+{
+    assert(out);
+    assert(file);
+    out->buf = (char *)calloc(OUT_CHUNK_SIZE, sizeof(char));
+    if (out->buf == NULL)
+        return LIST_PRINT_ALLOC_ERROR;
+
+    out->buf_size = OUT_CHUNK_SIZE;
+    out->pos = 0;
+    out->file = file;
+    out->overflow = false;
+    out->error = LIST_SUCCESS;
     return LIST_SUCCESS;
 }
 
-static list_status_t printOneElem(list_t * list, list_el_id_t index)
+static list_status_t outCtorBuf(out_buf_t * out, char * buf, size_t buf_size)
 {
-    assert(list);
-    void * list_elem = listGetElem(list, index);
-    for (size_t byte_index = 0; byte_index < list->elem_size; byte_index++){
-        printf("%02X ", *((unsigned char *)list_elem + byte_index));
-    }
+    assert(out);
+    assert(buf);
+    out->buf = buf;
+    out->buf_size = buf_size;
+    out->pos = 0;
+    out->file = NULL;
+    out->overflow = false;
+    out->error = LIST_SUCCESS;
     return LIST_SUCCESS;
 }
 
-static list_status_t elemToStr(list_t * list, list_el_id_t index, char * str)
+static list_status_t outDtor(out_buf_t * out)
+{
+    assert(out);
+    if (out->file == NULL)
+        return out->error;
+
+    outFlush(out);
+    // stdio may keep the tail in its own buffer, short write shows up only on fflush
+    if (!out->overflow && fflush(out->file) != 0)
+        outFail(out, LIST_PRINT_WRITE_ERROR);
+
+    free(out->buf);
+    out->buf = NULL;
+    return out->error;
+}
+
+static void outFail(out_buf_t * out, list_status_t error)
 {
+    assert(out);
+    if (out->error == LIST_SUCCESS)
+        out->error = error;
+
+    out->overflow = true;
+}
+
+static void outFlush(out_buf_t * out)
+{
+    assert(out);
+    if (out->file != NULL && out->pos > 0 && !out->overflow){
+        if (fwrite(out->buf, sizeof(char), out->pos, out->file) != out->pos)
+            outFail(out, LIST_PRINT_WRITE_ERROR);
+    }
+    out->pos = 0;
+}
+
+static bool outReserve(out_buf_t * out, size_t len)
+{
+    assert(out);
+    if (out->overflow)
+        return false;
+
+    if (out->buf_size - out->pos >= len)
+        return true;
+
+    if (out->file != NULL){
+        outFlush(out);
+        if (!out->overflow && out->buf_size >= len)
+            return true;
+    }
+    outFail(out, LIST_PRINT_BUF_OVERFLOW);
+    return false;
+}
+
+static void outWrite(out_buf_t * out, const char * str, size_t len)
+{
+    assert(out);
+    assert(str);
+    if (out->file != NULL && len > out->buf_size){
+        outFlush(out);
+        if (!out->overflow && fwrite(str, sizeof(char), len, out->file) != len)
+            outFail(out, LIST_PRINT_WRITE_ERROR);
+        return;
+    }
+    if (!outReserve(out, len))
+        return;
+
+    memcpy(out->buf + out->pos, str, len);
+    out->pos += len;
+}
+
+static void outStr(out_buf_t * out, const char * str)
+{
+    assert(out);
+    assert(str);
+    outWrite(out, str, strlen(str));
+}
+
+static void outInt(out_buf_t * out, long long val)
+{
+    assert(out);
+    char digits[OUT_INT_MAX_LEN] = "";
+    size_t len = 0;
+
+    unsigned long long abs_val = (val < 0) ? 0ULL - (unsigned long long)val : (unsigned long long)val;
+    do {
+        digits[OUT_INT_MAX_LEN - 1 - len] = (char)('0' + abs_val % 10);
+        abs_val /= 10;
+        len++;
+    } while (abs_val != 0);
+
+    if (val < 0){
+        digits[OUT_INT_MAX_LEN - 1 - len] = '-';
+        len++;
+    }
+    outWrite(out, digits + OUT_INT_MAX_LEN - len, len);
+}
+
+static bool isDotSpecial(char c)
+{
+    return c == '"' || c == '|' || c == '{' || c == '}' || c == '<' || c == '>' || c == '\\';
+}
+
+static bool hasDotSpecial(const char * str, size_t len)
+{
+    assert(str);
+    for (size_t char_index = 0; char_index < len; char_index++){
+        if (isDotSpecial(str[char_index]))
+            return true;
+    }
+    return false;
+}
+
+static void outFormatted(out_buf_t * out, list_t * list, const void * elem, bool dot_escape)
+{
+    assert(out);
     assert(list);
+    assert(list->formatter);
+    assert(elem);
+    if (out->overflow)
+        return;
+
+    if (out->file != NULL && out->buf_size - out->pos < OUT_ELEM_RESERVE)
+        outFlush(out);
+
+    size_t avail = out->buf_size - out->pos;
+    size_t len = list->formatter(elem, list->elem_size, out->buf + out->pos, avail);
+    bool need_escape = dot_escape && len < avail && hasDotSpecial(out->buf + out->pos, len);
+    if (len < avail && !need_escape){
+        out->pos += len;
+        return;
+    }
+    // output is truncated, caller buffer is over, file gets full empty chunk or temporary buffer
+    if (out->file == NULL && !need_escape){
+        outFail(out, LIST_PRINT_BUF_OVERFLOW);
+        return;
+    }
+    if (len < out->buf_size && !dot_escape){
+        outFlush(out);
+        if (out->overflow)
+            return;
+        out->pos = list->formatter(elem, list->elem_size, out->buf, out->buf_size);
+        return;
+    }
+    char * long_str = (char *)calloc(len + 1, sizeof(char));
+    if (long_str == NULL){
+        outFail(out, LIST_PRINT_ALLOC_ERROR);
+        return;
+    }
+    list->formatter(elem, list->elem_size, long_str, len + 1);
+    if (dot_escape)
+        outDotEscaped(out, long_str, len);
+    else
+        outWrite(out, long_str, len);
+    free(long_str);
+}
+
+static void outDotEscaped(out_buf_t * out, const char * str, size_t len)
+{
+    assert(out);
     assert(str);
-    void * list_elem = listGetElem(list, index);
-    for (size_t byte_index = 0; byte_index < list->elem_size; byte_index++){
-        sprintf(str + byte_index * 3, "%02X ", *((unsigned char *)list_elem + byte_index));
+    size_t run_start = 0;
+    for (size_t char_index = 0; char_index < len; char_index++){
+        if (!isDotSpecial(str[char_index]))
+            continue;
+
+        outWrite(out, str + run_start, char_index - run_start);
+        outWrite(out, "\\", 1);
+        run_start = char_index;
+    }
+    outWrite(out, str + run_start, len - run_start);
+}
+
+static void outElem(out_buf_t * out, list_t * list, list_el_id_t index, bool dot_escape)
+{
+    assert(out);
+    assert(list);
+    // no listGetElem here: it verifies the whole list, which makes dumps quadratic
+    const unsigned char * elem = (const unsigned char *)list->data + (size_t)(index - 1) * list->elem_size;
+
+    if (list->formatter != NULL){
+        outFormatted(out, list, elem, dot_escape);
+        return;
+    }
+
+    // table-driven hex, "XX " for each byte, written by blocks which fit in buffer
+    size_t byte_index = 0;
+    while (byte_index < list->elem_size){
+        if (!outReserve(out, 3))
+            return;
+
+        size_t block_len = (out->buf_size - out->pos) / 3;
+        if (block_len > list->elem_size - byte_index)
+            block_len = list->elem_size - byte_index;
+
+        char * dest = out->buf + out->pos;
+        for (size_t block_index = 0; block_index < block_len; block_index++){
+            unsigned char byte = elem[byte_index + block_index];
+            dest[3 * block_index]     = HEX_DIGITS[byte >> 4];
+            dest[3 * block_index + 1] = HEX_DIGITS[byte & 0xF];
+            dest[3 * block_index + 2] = ' ';
+        }
+        out->pos   += 3 * block_len;
+        byte_index += block_len;
     }
-    return LIST_SUCCESS;
 }
 
 void * listGetElem(list_t * list, list_el_id_t index)
 {
     assert(list);
     assert(listVerify(list) == LIST_SUCCESS);
+    // pointer is writable, so element data segment is saved to alive snapshots before it is given out
+    if (snapshotsSave(list, index, SNAP_DATA) != LIST_SUCCESS)
+        return NULL;
+
     void * list_elem_ptr = (char *)(list->data) + (index - 1) * list->elem_size;
     return list_elem_ptr;
 }
 
+list_status_t listSnapshot(list_t * list, list_snapshot_t ** snapshot)
+{
+    assert(list);
+    assert(snapshot);
+    assert(listVerify(list) == LIST_SUCCESS);
+    logPrint(LOG_DEBUG_PLUS, "making snapshot (cap = %d, size = %d)\n", list->capacity, list->size);
+
+    list_snapshot_t * new_snapshot = (list_snapshot_t *)calloc(1, sizeof(list_snapshot_t));
+    if (new_snapshot == NULL)
+        return LIST_SNAPSHOT_ALLOC_ERROR;
+
+    new_snapshot->list      = list;
+    new_snapshot->elem_size = list->elem_size;
+    new_snapshot->capacity  = list->capacity;
+    new_snapshot->size      = list->size;
+    new_snapshot->free      = list->free;
+
+    // segments cover indexes 0..capacity of next and prev, data has one element less
+    new_snapshot->seg_count = list->capacity / SNAPSHOT_SEG_LEN + 1;
+    size_t seg_count = (size_t)new_snapshot->seg_count;
+    new_snapshot->data_segs = (void **)        calloc(seg_count, sizeof(void *));
+    new_snapshot->next_segs = (list_el_id_t **)calloc(seg_count, sizeof(list_el_id_t *));
+    new_snapshot->prev_segs = (list_el_id_t **)calloc(seg_count, sizeof(list_el_id_t *));
+
+    if (new_snapshot->data_segs == NULL || new_snapshot->next_segs == NULL || new_snapshot->prev_segs == NULL){
+        new_snapshot->list = NULL;
+        listSnapshotRelease(new_snapshot);
+        return LIST_SNAPSHOT_ALLOC_ERROR;
+    }
+
+    new_snapshot->next_snapshot = list->snapshots;
+    list->snapshots = new_snapshot;
+
+    *snapshot = new_snapshot;
+    return LIST_SUCCESS;
+}
+
+list_status_t listSnapshotRelease(list_snapshot_t * snapshot)
+{
+    assert(snapshot);
+    logPrint(LOG_DEBUG_PLUS, "releasing snapshot\n");
+    if (snapshot->list != NULL){
+        list_snapshot_t ** link = &snapshot->list->snapshots;
+        while (*link != snapshot)
+            link = &(*link)->next_snapshot;
+
+        *link = snapshot->next_snapshot;
+    }
+
+    for (list_el_id_t seg = 0; seg < snapshot->seg_count; seg++){
+        if (snapshot->data_segs != NULL) free(snapshot->data_segs[seg]);
+        if (snapshot->next_segs != NULL) free(snapshot->next_segs[seg]);
+        if (snapshot->prev_segs != NULL) free(snapshot->prev_segs[seg]);
+    }
+    free(snapshot->data_segs);
+    free(snapshot->next_segs);
+    free(snapshot->prev_segs);
+    free(snapshot);
+    return LIST_SUCCESS;
+}
+
+list_el_id_t listSnapshotNext(const list_snapshot_t * snapshot, list_el_id_t index)
+{
+    assert(snapshot);
+    assert(0 <= index && index <= snapshot->capacity);
+    const list_el_id_t * seg = snapshot->next_segs[index / SNAPSHOT_SEG_LEN];
+    if (seg != NULL)
+        return seg[index % SNAPSHOT_SEG_LEN];
+
+    return snapshot->list->next[index];
+}
+
+list_el_id_t listSnapshotPrev(const list_snapshot_t * snapshot, list_el_id_t index)
+{
+    assert(snapshot);
+    assert(0 <= index && index <= snapshot->capacity);
+    const list_el_id_t * seg = snapshot->prev_segs[index / SNAPSHOT_SEG_LEN];
+    if (seg != NULL)
+        return seg[index % SNAPSHOT_SEG_LEN];
+
+    return snapshot->list->prev[index];
+}
+
+list_status_t listSnapshotCopyElem(const list_snapshot_t * snapshot, list_el_id_t index, void * dst)
+{
+    assert(snapshot);
+    assert(dst);
+    memcpy(dst, listSnapshotGetElem(snapshot, index), snapshot->elem_size);
+    return LIST_SUCCESS;
+}
+
+const void * listSnapshotGetElem(const list_snapshot_t * snapshot, list_el_id_t index)
+{
+    assert(snapshot);
+    assert(0 < index && index <= snapshot->capacity);
+    list_el_id_t data_index = index - 1;
+    const char * seg = (const char *)snapshot->data_segs[data_index / SNAPSHOT_SEG_LEN];
+    if (seg != NULL)
+        return seg + (size_t)(data_index % SNAPSHOT_SEG_LEN) * snapshot->elem_size;
+
+    return (const char *)snapshot->list->data + (size_t)data_index * snapshot->elem_size;
+}
+
+static list_status_t snapshotsSave(list_t * list, list_el_id_t index, unsigned arrays)
+{
+    assert(list);
+    for (list_snapshot_t * snapshot = list->snapshots; snapshot != NULL; snapshot = snapshot->next_snapshot){
+        // elements added after the snapshot was made are not visible in it
+        if (index > snapshot->capacity)
+            continue;
+
+        list_status_t status = LIST_SUCCESS;
+        if (arrays & (SNAP_NEXT | SNAP_PREV))
+            status = snapshotSaveSeg(snapshot, index / SNAPSHOT_SEG_LEN, arrays & (SNAP_NEXT | SNAP_PREV));
+
+        if (status == LIST_SUCCESS && (arrays & SNAP_DATA) && index > 0)
+            status = snapshotSaveSeg(snapshot, (index - 1) / SNAPSHOT_SEG_LEN, SNAP_DATA);
+
+        if (status != LIST_SUCCESS)
+            return status;
+    }
+    return LIST_SUCCESS;
+}
+
+static list_status_t snapshotSaveSeg(list_snapshot_t * snapshot, list_el_id_t seg, unsigned arrays)
+{
+    assert(snapshot);
+    assert(snapshot->list);
+    assert(0 <= seg && seg < snapshot->seg_count);
+    list_t * list = snapshot->list;
+    list_el_id_t seg_start = seg * SNAPSHOT_SEG_LEN;
+
+    list_el_id_t links_len = snapshot->capacity + 1 - seg_start;
+    if (links_len > SNAPSHOT_SEG_LEN)
+        links_len = SNAPSHOT_SEG_LEN;
+
+    if ((arrays & SNAP_NEXT) && snapshot->next_segs[seg] == NULL){
+        list_el_id_t * next_seg = (list_el_id_t *)calloc((size_t)links_len, sizeof(list_el_id_t));
+        if (next_seg == NULL)
+            return LIST_SNAPSHOT_ALLOC_ERROR;
+
+        memcpy(next_seg, list->next + seg_start, (size_t)links_len * sizeof(list_el_id_t));
+        snapshot->next_segs[seg] = next_seg;
+    }
+    if ((arrays & SNAP_PREV) && snapshot->prev_segs[seg] == NULL){
+        list_el_id_t * prev_seg = (list_el_id_t *)calloc((size_t)links_len, sizeof(list_el_id_t));
+        if (prev_seg == NULL)
+            return LIST_SNAPSHOT_ALLOC_ERROR;
+
+        memcpy(prev_seg, list->prev + seg_start, (size_t)links_len * sizeof(list_el_id_t));
+        snapshot->prev_segs[seg] = prev_seg;
+    }
+
+    list_el_id_t data_len = snapshot->capacity - seg_start;
+    if (data_len > SNAPSHOT_SEG_LEN)
+        data_len = SNAPSHOT_SEG_LEN;
+
+    if ((arrays & SNAP_DATA) && snapshot->data_segs[seg] == NULL && data_len > 0){
+        size_t data_seg_size = (size_t)data_len * snapshot->elem_size;
+        void * data_seg = calloc(data_seg_size, sizeof(char));
+        if (data_seg == NULL)
+            return LIST_SNAPSHOT_ALLOC_ERROR;
+
+        memcpy(data_seg, (char *)list->data + (size_t)seg_start * snapshot->elem_size, data_seg_size);
+        snapshot->data_segs[seg] = data_seg;
+    }
+    return LIST_SUCCESS;
+}
+
+static list_status_t snapshotDetach(list_snapshot_t * snapshot)
+{
+    assert(snapshot);
+    assert(snapshot->list);
+    assert(snapshot->list->snapshots == snapshot);
+    for (list_el_id_t seg = 0; seg < snapshot->seg_count; seg++){
+        list_status_t status = snapshotSaveSeg(snapshot, seg, SNAP_NEXT | SNAP_PREV | SNAP_DATA);
+        if (status != LIST_SUCCESS)
+            return status;
+    }
+    snapshot->list->snapshots = snapshot->next_snapshot;
+    snapshot->list = NULL;
+    snapshot->next_snapshot = NULL;
+    return LIST_SUCCESS;
+}
+
 list_status_t listVerify(list_t * list)
+{
+    assert(list);
+    return listVerifyFull(list, NULL);
+}
+
+list_status_t listVerifyFull(list_t * list, list_verify_report_t * report)
+{
+    assert(list);
+    // checks are two bounded sequential walks: a cycle that avoids 0 is fully symmetric,
+    // so no array-wide pass can prove connectivity without walking, and walks can not be split across threads
+    list_verify_report_t rep = {.status = LIST_SUCCESS, .bad_index = -1, .used_count = 0, .free_count = 0};
+    rep.status = verifyHeader(list);
+
+    if (rep.status == LIST_SUCCESS)
+        rep.status = verifyMainList(list, &rep);
+
+    if (rep.status == LIST_SUCCESS && rep.used_count != list->size)
+        rep.status = LIST_SIZE_MISMATCH_ERROR;
+
+    if (rep.status == LIST_SUCCESS)
+        rep.status = verifyFreeChain(list, &rep);
+
+    // both walks are disjoint (prev == -1 only in free chain), so together they must cover every slot
+    if (rep.status == LIST_SUCCESS && rep.used_count + rep.free_count != list->capacity){
+        rep.status = LIST_FREE_LEAK_ERROR;
+        rep.bad_index = findLostSlot(list);
+    }
+
+    if (report != NULL)
+        *report = rep;
+    return rep.status;
+}
+
+static list_status_t verifyHeader(list_t * list)
 {
     assert(list);
     if (list->capacity < 0)
@@ -300,19 +978,98 @@ list_status_t listVerify(list_t * list)
     if (list->elem_size == 0)
         return LIST_NO_ELEM_SIZE_ERROR;
 
-    list_el_id_t last_index = -1;
+    return LIST_SUCCESS;
+}
+
+static list_status_t verifyMainList(list_t * list, list_verify_report_t * report)
+{
+    assert(list);
+    assert(report);
+    // walk is bounded by capacity, so a cycle that avoids 0 is reported instead of hanging;
+    // broken prev link is remembered but the walk goes on to tell cycles from plain link errors
+    list_el_id_t bad_link_index = -1;
+    list_el_id_t last_index = 0;
     list_el_id_t index = list->next[0];
-    while (last_index != 0){
-        if (index < 0 || index > list->capacity)
+    while (true){
+        if (index < 0 || index > list->capacity){
+            report->bad_index = last_index;
             return LIST_PREV_NEXT_OUT_ERROR;
-        if (index != list->prev[list->next[index]])
-            return LIST_PREV_NEXT_ERROR;
+        }
+        if (list->prev[index] != last_index && bad_link_index == -1)
+            bad_link_index = index;
+
+        if (index == 0)
+            break;
+
+        report->used_count++;
+        // on the way back into the cycle its entry got prev mismatch, report it instead of current node
+        if (report->used_count > list->capacity){
+            report->bad_index = (bad_link_index != -1) ? bad_link_index : index;
+            return LIST_CYCLE_ERROR;
+        }
+        last_index = index;
+        index = list->next[index];
+    }
+    if (bad_link_index != -1){
+        report->bad_index = bad_link_index;
+        return LIST_PREV_NEXT_ERROR;
+    }
+    return LIST_SUCCESS;
+}
+
+static list_status_t verifyFreeChain(list_t * list, list_verify_report_t * report)
+{
+    assert(list);
+    assert(report);
+    list_el_id_t max_free_count = list->capacity - list->size;
+    list_el_id_t last_index = 0;
+    list_el_id_t index = list->free;
+    while (index != 0){
+        if (index < 0 || index > list->capacity){
+            report->bad_index = last_index;
+            return LIST_FREE_CHAIN_ERROR;
+        }
+        // occupied element in free chain, main list and free chain are not disjoint
+        if (list->prev[index] != -1){
+            report->bad_index = index;
+            return LIST_FREE_CHAIN_ERROR;
+        }
+        report->free_count++;
+        if (report->free_count > max_free_count){
+            report->bad_index = index;
+            return LIST_CYCLE_ERROR;
+        }
         last_index = index;
         index = list->next[index];
     }
     return LIST_SUCCESS;
 }
 
+static list_el_id_t findLostSlot(list_t * list)
+{
+    assert(list);
+    // only called on error path, walks are already known to be bounded and in range
+    char * reached = (char *)calloc((size_t)list->capacity + 1, sizeof(char));
+    if (reached == NULL)
+        return -1;
+
+    for (list_el_id_t index = list->next[0]; index != 0; index = list->next[index])
+        reached[index] = 1;
+
+    for (list_el_id_t index = list->free; index != 0; index = list->next[index])
+        reached[index] = 1;
+
+    list_el_id_t lost_index = -1;
+    for (list_el_id_t index = 1; index < list->capacity + 1; index++){
+        if (!reached[index]){
+            lost_index = index;
+            break;
+        }
+    }
+    free(reached);
+    return lost_index;
+}
+
 list_status_t listDump(list_t * list)
 {
     assert(list);
@@ -396,88 +1153,398 @@ list_status_t listMakeDot(list_t * list, FILE * dot_file)
     assert(list);
     assert(dot_file);
 
-    char * elem_str = (char *)calloc(3 * list->elem_size + 1, sizeof(char));
-
-    fprintf(dot_file, "digraph {\n");
-    fprintf(dot_file, "rankdir = LR;\n");
-    // fprintf(dot_file, "splines = ortho;\n");
-
-    fprintf(dot_file, "fontname = \"%s\";\n", font_name);
-    fprintf(dot_file, "node [fontname = \"%s\", style=filled, color=\"#000000\", fillcolor=\"#FFFFFF\"];\n", font_name);
-    fprintf(dot_file, "bgcolor  = \"%s\";\n", bg_color);
-
-
-    fprintf(dot_file, "node_0 [shape=Mrecord,label=\"element #0 | prev = %d | next = %d\",%s];\n",
-            list->prev[0], list->next[0], null_element_color);
+    out_buf_t dot = {};
+    list_status_t status = outCtorFile(&dot, dot_file);
+    if (status != LIST_SUCCESS)
+        return status;
+
+    outStr(&dot, "digraph {\n");
+    outStr(&dot, "rankdir = LR;\n");
+
+    outStr(&dot, "fontname = \""); outStr(&dot, font_name); outStr(&dot, "\";\n");
+    outStr(&dot, "node [fontname = \""); outStr(&dot, font_name);
+    outStr(&dot, "\", style=filled, color=\"#000000\", fillcolor=\"#FFFFFF\"];\n");
+    outStr(&dot, "bgcolor  = \""); outStr(&dot, bg_color); outStr(&dot, "\";\n");
+
+    outStr(&dot, "node_0 [shape=Mrecord,label=\"element #0 | prev = "); outInt(&dot, list->prev[0]);
+    outStr(&dot, " | next = "); outInt(&dot, list->next[0]);
+    outStr(&dot, "\","); outStr(&dot, null_element_color); outStr(&dot, "];\n");
+
+    outStr(&dot, "header_node [shape=Mrecord, label=\"HEADER | cap = "); outInt(&dot, list->capacity);
+    outStr(&dot, " | size = "); outInt(&dot, list->size);
+    outStr(&dot, " | free = "); outInt(&dot, list->free);
+    outStr(&dot, " | elem_size = "); outInt(&dot, (long long)list->elem_size);
+    outStr(&dot, "\"];\n");
+    outStr(&dot, "header_node->node_0 ["); outStr(&dot, main_arrows_color_str); outStr(&dot, "];\n");
+
+    outStr(&dot, "subgraph cluster_main_list {\n");
+    outStr(&dot, "style=filled; color = \""); outStr(&dot, list_bg_color); outStr(&dot, "\";\n");
+    outStr(&dot, "label = \"main list\";\n");
+    outStr(&dot, "fontname = \""); outStr(&dot, font_name); outStr(&dot, "\";\n");
+    outStr(&dot, "pencolor = \"#000000\";\n");
+    for (list_el_id_t index = 1; index < list->capacity + 1; index++){
+        const char * color_str = (list->prev[index] == -1) ? free_elem_color_str : occupied_elem_color_str;
+        outStr(&dot, "node_"); outInt(&dot, index);
+        outStr(&dot, " [shape=Mrecord,label=\"element #"); outInt(&dot, index);
+        outStr(&dot, " | prev = "); outInt(&dot, list->prev[index]);
+        outStr(&dot, " | next = "); outInt(&dot, list->next[index]);
+        outStr(&dot, (list->formatter == NULL) ? " | val = 0x " : " | val = ");
+        outElem(&dot, list, index, true);
+        outStr(&dot, "\", "); outStr(&dot, color_str); outStr(&dot, "];\n");
+    }
+    outStr(&dot, "}\n");
 
-    fprintf(dot_file, "header_node [shape=Mrecord, label=\"HEADER | cap = %d | size = %d | free = %d | elem_size = %d\"];\n",
-            list->capacity, list->size, list->free, list->elem_size);
-    fprintf(dot_file, "header_node->node_0 [%s];\n", main_arrows_color_str);
+    for (list_el_id_t index = 0; index < list->capacity; index++){
+        outStr(&dot, "node_"); outInt(&dot, index); outStr(&dot, "->node_"); outInt(&dot, index + 1);
+        outStr(&dot, " ["); outStr(&dot, main_arrows_color_str); outStr(&dot, "];\n");
+    }
 
-    list_el_id_t index = 1;
+    dotLinkChain(&dot, list, list->next, list->next[0], true, next_arrows_color_str);
+    dotLinkChain(&dot, list, list->prev, list->prev[0], true, prev_arrows_color_str);
 
-    fprintf(dot_file, "subgraph cluster_main_list {\n");
-    fprintf(dot_file, "style=filled; color = \"%s\";\n", list_bg_color);
-    fprintf(dot_file, "label = \"main list\";\n", list_bg_color);
-    fprintf(dot_file, "fontname = \"%s\";\n", font_name);
-    fprintf(dot_file, "pencolor = \"#000000\";\n");
-    while (index < list->capacity + 1){
-        elemToStr(list, index, elem_str);
-        const char * color_str = (list->prev[index] == -1) ? free_elem_color_str : occupied_elem_color_str;
-        fprintf(dot_file, "node_%d [shape=Mrecord,label=\"element #%d | prev = %d | next = %d | val = 0x %s\", %s];\n",
-                index, index, list->prev[index], list->next[index], elem_str, color_str);
-        index++;
+    if (list->free == 0){
+        outStr(&dot, "node_free [shape=Mrecord, label=\"free = 0 | no free elems\", ");
+        outStr(&dot, free_label_color); outStr(&dot, "];\n");
     }
-    fprintf(dot_file, "}\n");
-
-    index = 0;
-    while (index < list->capacity){
-        fprintf(dot_file, "node_%d->node_%d [%s];\n", index, index + 1, main_arrows_color_str);
-        index++;
+    else {
+        outStr(&dot, "node_free [shape=Mrecord, label=\"free = "); outInt(&dot, list->free);
+        outStr(&dot, " | exists\", "); outStr(&dot, free_label_color); outStr(&dot, "];\n");
+        outStr(&dot, "node_free->node_"); outInt(&dot, list->free); outStr(&dot, " [weight=0];\n");
     }
+    dotLinkChain(&dot, list, list->next, list->free, false, free_arrows_color_str);
+
+    outStr(&dot, "}\n");
 
-    index = list->next[0];
+    return outDtor(&dot);
+}
+
+static void dotLinkChain(out_buf_t * dot, list_t * list, list_el_id_t * links, list_el_id_t start,
+                         bool through_zero, const char * color_str)
+{
+    assert(dot);
+    assert(list);
+    assert(links);
+    assert(color_str);
+    // chain is walked until 0 is reached (or passed if through_zero), number of steps is bounded for broken lists
+    list_el_id_t index = start;
     list_el_id_t last_index = -1;
     size_t rec_count = 0;
-    while (last_index != 0){
+    while (last_index != 0 && index >= 0 && index <= list->capacity){
+        if (index == 0 && !through_zero)
+            break;
         if (rec_count > (size_t)list->capacity + 1)
             break;
         rec_count++;
 
-        fprintf(dot_file, "node_%d->node_%d [%s,constraint=false];\n",
-                index, list->next[index], next_arrows_color_str);
+        outStr(dot, "node_"); outInt(dot, index); outStr(dot, "->node_"); outInt(dot, links[index]);
+        outStr(dot, " ["); outStr(dot, color_str); outStr(dot, ",constraint=false];\n");
         last_index = index;
-        index = list->next[index];
+        index = links[index];
     }
-    index = list->prev[0];
-    last_index = -1;
-    rec_count = 0;
-    while (last_index != 0){
-        if (rec_count > (size_t)list->capacity + 1)
-            break;
-        rec_count++;
+}
 
-        fprintf(dot_file, "node_%d->node_%d [%s,constraint=false];\n",
-                index, list->prev[index], prev_arrows_color_str);
-        last_index = index;
-        index = list->prev[index];
+list_status_t listBatchCtor(list_batch_t * batch, list_t * list)
+{
+    assert(batch);
+    assert(list);
+    batch->list = list;
+    batch->ops = NULL;
+    batch->vals = NULL;
+    batch->ops_count = 0;
+    batch->ops_capacity = 0;
+    batch->insert_count = 0;
+    batch->vals_capacity = 0;
+    batch->failed_op = -1;
+    return LIST_SUCCESS;
+}
+
+list_status_t listBatchDtor(list_batch_t * batch)
+{
+    assert(batch);
+    free(batch->ops);
+    batch->ops = NULL;
+
+    free(batch->vals);
+    batch->vals = NULL;
+
+    batch->ops_count = 0;
+    batch->ops_capacity = 0;
+    batch->insert_count = 0;
+    batch->vals_capacity = 0;
+    return LIST_SUCCESS;
+}
+
+list_status_t listBatchClear(list_batch_t * batch)
+{
+    assert(batch);
+    batch->ops_count = 0;
+    batch->insert_count = 0;
+    batch->failed_op = -1;
+    return LIST_SUCCESS;
+}
+
+list_status_t listBatchInsertAfter(list_batch_t * batch, list_el_id_t index, const void * val)
+{
+    assert(batch);
+    assert(val);
+    return batchAddOp(batch, LIST_OP_INSERT_AFTER, index, val);
+}
+
+list_status_t listBatchInsertBefore(list_batch_t * batch, list_el_id_t index, const void * val)
+{
+    assert(batch);
+    assert(val);
+    return batchAddOp(batch, LIST_OP_INSERT_BEFORE, index, val);
+}
+
+list_status_t listBatchRemove(list_batch_t * batch, list_el_id_t index)
+{
+    assert(batch);
+    return batchAddOp(batch, LIST_OP_REMOVE, index, NULL);
+}
+
+static list_status_t batchAddOp(list_batch_t * batch, list_op_type_t type, list_el_id_t index, const void * val)
+{
+    assert(batch);
+    assert(batch->list);
+    size_t elem_size = batch->list->elem_size;
+
+    if (batch->ops_count == batch->ops_capacity){
+        list_el_id_t new_capacity = (batch->ops_capacity > 0) ? batch->ops_capacity * (list_el_id_t)CAP_MULTIPLIER
+                                                                 : (list_el_id_t)MIN_CAPACITY;
+        list_op_t * new_ops = (list_op_t *)realloc(batch->ops, (size_t)new_capacity * sizeof(list_op_t));
+        if (new_ops == NULL)
+            return LIST_BATCH_ALLOC_ERROR;
+        batch->ops = new_ops;
+        batch->ops_capacity = new_capacity;
+    }
+    // values are kept only for inserts, removes do not take place in vals
+    if (val != NULL && batch->insert_count == batch->vals_capacity){
+        list_el_id_t new_capacity = (batch->vals_capacity > 0) ? batch->vals_capacity * (list_el_id_t)CAP_MULTIPLIER
+                                                                  : (list_el_id_t)MIN_CAPACITY;
+        void * new_vals = realloc(batch->vals, (size_t)new_capacity * elem_size);
+        if (new_vals == NULL)
+            return LIST_BATCH_ALLOC_ERROR;
+        batch->vals = new_vals;
+        batch->vals_capacity = new_capacity;
     }
 
-    if (list->free == 0)
-        fprintf(dot_file, "node_free [shape=Mrecord, label=\"free = 0 | no free elems\", %s];\n", free_label_color);
-    else {
-        fprintf(dot_file, "node_free [shape=Mrecord, label=\"free = %d | exists\", %s];\n", list->free, free_label_color);
-        fprintf(dot_file, "node_free->node_%d [weight=0];\n", list->free);
+    list_op_t * op = batch->ops + batch->ops_count;
+    op->type  = type;
+    op->index = index;
+    op->val_index = -1;
+    if (val != NULL){
+        op->val_index = batch->insert_count;
+        memcpy((char *)batch->vals + (size_t)op->val_index * elem_size, val, elem_size);
+        batch->insert_count++;
     }
-    index = list->free;
-    while (index != 0){
-        fprintf(dot_file, "node_%d->node_%d [%s,constraint=false];\n",
-                index, list->next[index], free_arrows_color_str);
-        index = list->next[index];
+    batch->ops_count++;
+    return LIST_SUCCESS;
+}
+
+list_status_t listBatchCommit(list_batch_t * batch)
+{
+    assert(batch);
+    assert(batch->list);
+    list_t * list = batch->list;
+    assert(listVerify(list) == LIST_SUCCESS);
+    logPrint(LOG_DEBUG_PLUS, "committing batch (ops = %d, inserts = %d)\n\tcap = %d, size = %d\n",
+                             batch->ops_count, batch->insert_count, list->capacity, list->size);
+    batch->failed_op = -1;
+    if (batch->ops_count == 0)
+        return LIST_SUCCESS;
+
+    // capacity is reserved once, so no op needs reallocation;
+    // rollback restores old capacity and free, new slots stay allocated but unused
+    list_el_id_t old_size     = list->size;
+    list_el_id_t old_free     = list->free;
+    list_el_id_t old_capacity = list->capacity;
+
+    list_el_id_t need_capacity = list->size + batch->insert_count;
+    if (need_capacity > list->capacity){
+        list_el_id_t new_capacity = list->capacity * (list_el_id_t)CAP_MULTIPLIER;
+        if (new_capacity < need_capacity)
+            new_capacity = need_capacity;
+
+        list_status_t status = listReserve(list, new_capacity);
+        if (status != LIST_SUCCESS)
+            return status;
+    }
+
+    undo_log_t undo = {};
+    list_status_t status = undoLogCtor(&undo, batch->ops_count, batch->insert_count, list->elem_size);
+    if (status != LIST_SUCCESS){
+        batchRollback(list, &undo, old_size, old_free, old_capacity);
+        return status;
     }
 
-    fprintf(dot_file, "}\n");
+    for (list_el_id_t op_index = 0; op_index < batch->ops_count; op_index++){
+        const list_op_t * op = batch->ops + op_index;
+        const void * val = (op->val_index >= 0) ? (char *)batch->vals + (size_t)op->val_index * list->elem_size : NULL;
+        status = batchApplyOp(list, op, val, &undo);
+        if (status != LIST_SUCCESS){
+            batch->failed_op = op_index;
+            break;
+        }
+    }
+
+    if (status == LIST_SUCCESS)
+        status = listVerify(list);
+
+    if (status != LIST_SUCCESS){
+        logPrint(LOG_DEBUG_PLUS, "batch failed (status = %d, op = %d), rolling back\n", status, batch->failed_op);
+        batchRollback(list, &undo, old_size, old_free, old_capacity);
+    }
+    else
+        listBatchClear(batch);
+
+    undoLogDtor(&undo);
+    logPrint(LOG_DEBUG_PLUS, "exiting listBatchCommit (new size = %d)\n", list->size);
+    return status;
+}
 
-    free(elem_str);
+static list_status_t batchApplyOp(list_t * list, const list_op_t * op, const void * val, undo_log_t * undo)
+{
+    assert(list);
+    assert(op);
+    assert(undo);
+    list_el_id_t index = op->index;
+    if (index < 0 || index > list->capacity)
+        return LIST_PREV_NEXT_OUT_ERROR;
+
+    if (index != 0 && list->prev[index] == -1)
+        return LIST_BATCH_OP_ERROR;
+
+    list_status_t status = LIST_SUCCESS;
+    switch (op->type){
+        case LIST_OP_INSERT_AFTER:
+        case LIST_OP_INSERT_BEFORE:
+        {
+            assert(list->free != 0);
+            list_el_id_t new_index  = list->free;
+            list_el_id_t prev_index = (op->type == LIST_OP_INSERT_AFTER) ? index : list->prev[index];
+            list_el_id_t next_index = (op->type == LIST_OP_INSERT_AFTER) ? list->next[index] : index;
+
+            status = snapshotsSave(list, prev_index, SNAP_NEXT);
+            if (status == LIST_SUCCESS)
+                status = snapshotsSave(list, new_index, SNAP_NEXT | SNAP_PREV | SNAP_DATA);
+            if (status == LIST_SUCCESS)
+                status = snapshotsSave(list, next_index, SNAP_PREV);
+            if (status != LIST_SUCCESS)
+                return status;
+
+            list->free = list->next[new_index];
+
+            batchSetLink(&list->next[prev_index], new_index,  undo);
+            batchSetLink(&list->prev[new_index],  prev_index, undo);
+            batchSetLink(&list->next[new_index],  next_index, undo);
+            batchSetLink(&list->prev[next_index], new_index,  undo);
+
+            batchSetData(list, new_index, val, undo);
+            list->size++;
+            break;
+        }
+        case LIST_OP_REMOVE:
+        {
+            if (index == 0)
+                return LIST_DELETE_ZERO_ERROR;
+
+            list_el_id_t prev_index = list->prev[index];
+            list_el_id_t next_index = list->next[index];
+
+            status = snapshotsSave(list, prev_index, SNAP_NEXT);
+            if (status == LIST_SUCCESS)
+                status = snapshotsSave(list, next_index, SNAP_PREV);
+            if (status == LIST_SUCCESS)
+                status = snapshotsSave(list, index, SNAP_NEXT | SNAP_PREV);
+            if (status != LIST_SUCCESS)
+                return status;
+
+            batchSetLink(&list->next[prev_index], next_index, undo);
+            batchSetLink(&list->prev[next_index], prev_index, undo);
+            batchSetLink(&list->prev[index],      -1,         undo);
+            batchSetLink(&list->next[index],      list->free, undo);
+
+            list->free = index;
+            list->size--;
+            break;
+        }
+        default:
+            return LIST_BATCH_OP_ERROR;
+    }
+    return LIST_SUCCESS;
+}
+
+static list_status_t undoLogCtor(undo_log_t * undo, list_el_id_t ops_count, list_el_id_t insert_count, size_t elem_size)
+{
+    assert(undo);
+    undo->links      = (undo_entry_t *)calloc((size_t)(ops_count * BATCH_LINKS_PER_OP), sizeof(undo_entry_t));
+    undo->data       = (char *)        calloc((size_t)insert_count, elem_size);
+    undo->data_index = (list_el_id_t *)calloc((size_t)insert_count, sizeof(list_el_id_t));
+    undo->links_count = 0;
+    undo->data_count  = 0;
+
+    if (undo->links == NULL || (insert_count > 0 && (undo->data == NULL || undo->data_index == NULL))){
+        undoLogDtor(undo);
+        return LIST_BATCH_ALLOC_ERROR;
+    }
     return LIST_SUCCESS;
 }
+
+static void undoLogDtor(undo_log_t * undo)
+{
+    assert(undo);
+    free(undo->links);
+    undo->links = NULL;
+
+    free(undo->data);
+    undo->data = NULL;
+
+    free(undo->data_index);
+    undo->data_index = NULL;
+}
+
+static void batchSetLink(list_el_id_t * link, list_el_id_t new_val, undo_log_t * undo)
+{
+    assert(link);
+    assert(undo);
+    undo->links[undo->links_count].link    = link;
+    undo->links[undo->links_count].old_val = *link;
+    undo->links_count++;
+
+    *link = new_val;
+}
+
+static void batchSetData(list_t * list, list_el_id_t index, const void * val, undo_log_t * undo)
+{
+    assert(list);
+    assert(val);
+    assert(undo);
+    char * elem = (char *)list->data + (size_t)(index - 1) * list->elem_size;
+
+    memcpy(undo->data + undo->data_count * list->elem_size, elem, list->elem_size);
+    undo->data_index[undo->data_count] = index;
+    undo->data_count++;
+
+    memcpy(elem, val, list->elem_size);
+}
+
+static void batchRollback(list_t * list, undo_log_t * undo,
+                          list_el_id_t old_size, list_el_id_t old_free, list_el_id_t old_capacity)
+{
+    assert(list);
+    assert(undo);
+    // all changed links and data were saved to snapshots before the first write, so restoring needs no saving
+    while (undo->links_count > 0){
+        undo->links_count--;
+        *undo->links[undo->links_count].link = undo->links[undo->links_count].old_val;
+    }
+    while (undo->data_count > 0){
+        undo->data_count--;
+        char * elem = (char *)list->data + (size_t)(undo->data_index[undo->data_count] - 1) * list->elem_size;
+        memcpy(elem, undo->data + undo->data_count * list->elem_size, list->elem_size);
+    }
+    list->size     = old_size;
+    list->free     = old_free;
+    list->capacity = old_capacity;
+}
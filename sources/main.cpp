@@ -1,9 +1,36 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "logger.h"
 #include "list.h"
 
+/// @brief corrupts list in different ways and checks status and bad index of full verification
+static bool verifyCheck();
+
+/// @brief checks that full verification of list gives status and bad_index
+static bool verifyCase(list_t * list, list_status_t status, list_el_id_t bad_index);
+
+/// @brief checks formatter output in dot and print, long formatter output and print to small buffer
+static bool printCheck();
+
+/// @brief formatter which writes chars that are special in dot labels
+static size_t specialFormatter(const void * elem, size_t elem_size, char * str, size_t str_size);
+
+/// @brief formatter which writes LONG_ELEM_LEN chars, longer than output chunk
+static size_t longFormatter(const void * elem, size_t elem_size, char * str, size_t str_size);
+
+/// @brief reads whole file to new null-terminated string, returns NULL on error
+static char * readWholeFile(FILE * file, size_t * len);
+
+const size_t LONG_ELEM_LEN = 100000;
+
+/// @brief makes snapshot, changes list and checks that snapshot keeps old contents
+static bool snapshotCheck();
+
+/// @brief commits failing batch and checks that list is unchanged, then commits large valid batch
+static bool batchCheck();
+
 int main()
 {
     system("mkdir -p \"logs\"");
@@ -32,7 +59,237 @@ int main()
 
     printf("list verify: %d\n", listVerify(&mylist));
     listDtor (&mylist);
+
+    printf("verify check: %s\n", verifyCheck() ? "OK" : "FAILED");
+    printf("print check: %s\n", printCheck() ? "OK" : "FAILED");
+    printf("snapshot check: %s\n", snapshotCheck() ? "OK" : "FAILED");
+    printf("batch check: %s\n", batchCheck() ? "OK" : "FAILED");
     fclose(dot_file);
     logExit();
     return 0;
 }
+
+static bool verifyCheck()
+{
+    list_t list = {};
+    listCtor(&list, sizeof(int), 0);
+    for (int i = 0; i < 10; i++)
+        listInsertBack(&list, &i);
+
+    // elements 1..10 go one by one, free chain is 5 -> 11 -> ... -> 16
+    listRemove(&list, 5);
+    bool is_ok = verifyCase(&list, LIST_SUCCESS, -1);
+
+    // cycle 1 -> 2 -> 3 -> 2 avoids 0, its entry is 2
+    list_el_id_t saved_link = list.next[3];
+    list.next[3] = 2;
+    is_ok = is_ok && verifyCase(&list, LIST_CYCLE_ERROR, 2);
+    list.next[3] = saved_link;
+
+    // free element 11 looks occupied
+    saved_link = list.prev[11];
+    list.prev[11] = 10;
+    is_ok = is_ok && verifyCase(&list, LIST_FREE_CHAIN_ERROR, 11);
+    list.prev[11] = saved_link;
+
+    // self loop in free chain
+    saved_link = list.next[list.free];
+    list.next[list.free] = list.free;
+    is_ok = is_ok && verifyCase(&list, LIST_CYCLE_ERROR, list.free);
+    list.next[list.free] = saved_link;
+
+    // element 2 is unlinked from main list but not freed
+    list.next[1] = 3;
+    list.prev[3] = 1;
+    list.size--;
+    is_ok = is_ok && verifyCase(&list, LIST_FREE_LEAK_ERROR, 2);
+    list.next[1] = 2;
+    list.prev[3] = 2;
+    list.size++;
+
+    is_ok = is_ok && verifyCase(&list, LIST_SUCCESS, -1);
+    listDtor(&list);
+    return is_ok;
+}
+
+static bool verifyCase(list_t * list, list_status_t status, list_el_id_t bad_index)
+{
+    list_verify_report_t report = {};
+    listVerifyFull(list, &report);
+    return report.status == status && report.bad_index == bad_index;
+}
+
+static bool printCheck()
+{
+    const int elem_count = 3;
+    list_t list = {};
+    listCtor(&list, sizeof(int), 0);
+    for (int i = 0; i < elem_count; i++)
+        listInsertBack(&list, &i);
+
+    // special chars are escaped in dot labels
+    listSetElemFormatter(&list, specialFormatter);
+    FILE * check_file = tmpfile();
+    bool is_ok = (check_file != NULL) && (listMakeDot(&list, check_file) == LIST_SUCCESS);
+    size_t file_len = 0;
+    char * file_str = (check_file != NULL) ? readWholeFile(check_file, &file_len) : NULL;
+    is_ok = is_ok && file_str != NULL && strstr(file_str, "val = 0\\|\\\"\\{\\}\"") != NULL;
+    free(file_str);
+    if (check_file != NULL)
+        fclose(check_file);
+
+    // element longer than output chunk is printed in full
+    listSetElemFormatter(&list, longFormatter);
+    check_file = tmpfile();
+    is_ok = is_ok && (check_file != NULL) && (listPrintToFile(&list, check_file) == LIST_SUCCESS);
+    file_str = (check_file != NULL) ? readWholeFile(check_file, &file_len) : NULL;
+    size_t expected_len = strlen("\nstarted printing list\n") + strlen("ended printing list\n")
+                        + (size_t)elem_count * (strlen("elem #1: ") + LONG_ELEM_LEN + 1);
+    is_ok = is_ok && file_str != NULL && file_len == expected_len;
+    free(file_str);
+    if (check_file != NULL)
+        fclose(check_file);
+
+    // small caller buffer overflows, written part is reported
+    char small_buf[40] = "";
+    size_t written = 0;
+    is_ok = is_ok && (listPrintToBuf(&list, small_buf, sizeof(small_buf), &written) == LIST_PRINT_BUF_OVERFLOW);
+    is_ok = is_ok && written > 0 && written <= sizeof(small_buf)
+                  && strncmp(small_buf, "\nstarted printing list\n", strlen("\nstarted printing list\n")) == 0;
+
+    listDtor(&list);
+    return is_ok;
+}
+
+static size_t specialFormatter(const void * elem, size_t elem_size, char * str, size_t str_size)
+{
+    (void)elem_size;
+    int len = snprintf(str, str_size, "%d|\"{}", *(const int *)elem);
+    return (len < 0) ? 0 : (size_t)len;
+}
+
+static size_t longFormatter(const void * elem, size_t elem_size, char * str, size_t str_size)
+{
+    (void)elem;
+    (void)elem_size;
+    size_t len = (str_size < LONG_ELEM_LEN) ? str_size : LONG_ELEM_LEN;
+    memset(str, 'x', len);
+    return LONG_ELEM_LEN;
+}
+
+static char * readWholeFile(FILE * file, size_t * len)
+{
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    if (file_size < 0)
+        return NULL;
+
+    rewind(file);
+    char * str = (char *)calloc((size_t)file_size + 1, sizeof(char));
+    if (str == NULL)
+        return NULL;
+
+    *len = fread(str, sizeof(char), (size_t)file_size, file);
+    return str;
+}
+
+static bool snapshotCheck()
+{
+    const int elem_count = 3000;
+    list_t list = {};
+    listCtor(&list, sizeof(int), 0);
+    for (int i = 0; i < elem_count; i++)
+        listInsertBack(&list, &i);
+
+    list_snapshot_t * snapshot = NULL;
+    if (listSnapshot(&list, &snapshot) != LIST_SUCCESS)
+        return false;
+
+    // in-place write through element pointer is not seen in snapshot
+    int * tail_val = (int *)listGetElem(&list, listGetTailIndex(&list));
+    *tail_val = -1;
+
+    for (int i = 0; i < elem_count / 2; i++)
+        listRemoveFirst(&list);
+    for (int i = 0; i < elem_count; i++)
+        listInsertFront(&list, &i);
+
+    bool is_ok = (snapshot->size == elem_count);
+    int expected = 0;
+    for (list_el_id_t index = listSnapshotNext(snapshot, 0); index != 0; index = listSnapshotNext(snapshot, index)){
+        int val = 0;
+        listSnapshotCopyElem(snapshot, index, &val);
+        is_ok = is_ok && (val == expected);
+        expected++;
+    }
+    is_ok = is_ok && (expected == elem_count);
+
+    // list destructor detaches snapshot, it stays readable until release
+    listDtor(&list);
+    expected = elem_count - 1;
+    for (list_el_id_t index = listSnapshotPrev(snapshot, 0); index != 0; index = listSnapshotPrev(snapshot, index)){
+        int val = 0;
+        listSnapshotCopyElem(snapshot, index, &val);
+        is_ok = is_ok && (val == expected);
+        expected--;
+    }
+    is_ok = is_ok && (expected == -1) && (snapshot->list == NULL);
+
+    listSnapshotRelease(snapshot);
+    return is_ok;
+}
+
+static bool batchCheck()
+{
+    const int elem_count  = 100;
+    const int batch_count = 5000;
+    list_t list = {};
+    listCtor(&list, sizeof(int), 0);
+    for (int i = 0; i < elem_count; i++)
+        listInsertBack(&list, &i);
+
+    list_el_id_t old_capacity = list.capacity;
+    list_el_id_t old_size     = list.size;
+    list_el_id_t old_free     = list.free;
+    size_t links_size = (size_t)(old_capacity + 1) * sizeof(list_el_id_t);
+    size_t data_size  = (size_t)old_capacity * list.elem_size;
+    list_el_id_t * old_next = (list_el_id_t *)calloc(1, links_size);
+    list_el_id_t * old_prev = (list_el_id_t *)calloc(1, links_size);
+    void         * old_data = calloc(1, data_size);
+    memcpy(old_next, list.next, links_size);
+    memcpy(old_prev, list.prev, links_size);
+    memcpy(old_data, list.data, data_size);
+
+    // inserts need reserve, last op removes element which is already free
+    list_batch_t batch = {};
+    listBatchCtor(&batch, &list);
+    for (int i = 0; i < batch_count; i++)
+        listBatchInsertAfter(&batch, 0, &i);
+    listBatchRemove(&batch, 1);
+    listBatchRemove(&batch, 1);
+
+    bool is_ok = (listBatchCommit(&batch) != LIST_SUCCESS) && (batch.failed_op == batch_count + 1);
+    is_ok = is_ok && list.capacity == old_capacity && list.size == old_size && list.free == old_free;
+    is_ok = is_ok && memcmp(old_next, list.next, links_size) == 0
+                  && memcmp(old_prev, list.prev, links_size) == 0
+                  && memcmp(old_data, list.data, data_size)  == 0;
+    free(old_next);
+    free(old_prev);
+    free(old_data);
+
+    listBatchClear(&batch);
+    for (int i = 0; i < batch_count; i++)
+        listBatchInsertBefore(&batch, 0, &i);
+    for (list_el_id_t index = 1; index <= elem_count; index += 2)
+        listBatchRemove(&batch, index);
+
+    // one reserve: capacity is exactly what was needed, not a result of repeated doubling
+    is_ok = is_ok && (listBatchCommit(&batch) == LIST_SUCCESS) && (batch.ops_count == 0);
+    is_ok = is_ok && list.capacity == old_size + batch_count;
+    is_ok = is_ok && list.size == old_size + batch_count - elem_count / 2;
+    is_ok = is_ok && listVerify(&list) == LIST_SUCCESS;
+
+    listBatchDtor(&batch);
+    listDtor(&list);
+    return is_ok;
+}